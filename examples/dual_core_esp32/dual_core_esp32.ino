@@ -0,0 +1,31 @@
+// Build with -DVOLVODIM_ENABLE_THREADED=1 (e.g. PlatformIO build_flags) so
+// publish() and transmit() are available.
+#include <VolvoDIM.h>
+
+VolvoDIM VolvoDIM(5); //SPI pin for your can bus shield
+
+// Runs the frame scheduler on core 0 while loop() handles telemetry on core 1.
+void transmitTask(void* arg) {
+  for (;;) {
+    VolvoDIM.transmit();
+    vTaskDelay(1);
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  VolvoDIM.init(); //This will power your dim with the default values
+  xTaskCreatePinnedToCore(transmitTask, "dimTx", 4096, NULL, 1, NULL, 0);
+}
+
+void loop() {
+  // Expects "rpm,speed\n" lines from the host
+  if (Serial.available()) {
+    int rpm = Serial.parseInt();
+    int speed = Serial.parseInt();
+    Serial.readStringUntil('\n');
+    VolvoDIM.setRpm(rpm);
+    VolvoDIM.setSpeed(speed);
+  }
+  VolvoDIM.publish(); // Hands the latest values to the transmit task
+}
@@ -0,0 +1,27 @@
+#include <VolvoDIM.h>
+
+VolvoDIM VolvoDIM(9); //SPI pin for your can bus shield
+//3 is used for the Arduino MKR Wifi 1010 Can Shield
+//9 is used for the Arduino Uno Can Bus Shield V2.0
+//10 is used for the Arduino Uno Can Bus Shield V1.2
+
+// Idle attract mode: the tachometer breathes between idle and 3000 rpm.
+// Keyframe tables must live in flash (PROGMEM).
+const VolvoDIM::Keyframe attractRpm[] PROGMEM = {
+  {0, 800, VolvoDIM::EASE_STEP},
+  {1500, 3000, VolvoDIM::EASE_IN_OUT},
+  {3000, 800, VolvoDIM::EASE_IN_OUT}
+};
+
+void setup() {
+  VolvoDIM.init(); //This will power your dim with the default values
+  VolvoDIM.sweepGauges(); //Starts the startup sweep, it plays while simulate() runs
+}
+
+void loop() {
+  // Once the sweep is over, loop the attract mode until telemetry arrives
+  if (!VolvoDIM.isAnimating(VolvoDIM::ANIM_RPM)) {
+    VolvoDIM.playAnimation(VolvoDIM::ANIM_RPM, attractRpm, 3, true);
+  }
+  VolvoDIM.simulate(); // This needs to be placed in the loop for the dim to power up
+}
@@ -7,7 +7,10 @@ VolvoDIM VolvoDIM(9,1); //SPI pin for your can bus shield, physical output pin f
 void setup() {
   VolvoDIM.gaugeReset(); //This will give your dim 7 seconds to reset before simulating (only works if using a relay)
   VolvoDIM.init(); //This will power your dim with the default values
-  VolvoDIM.sweepGauges();
+  VolvoDIM.sweepGauges(); //This sweeps the needles, setting rpm or speed before it finishes cancels it
+  while (VolvoDIM.isAnimating(VolvoDIM::ANIM_RPM)) {
+    VolvoDIM.simulate(); //The sweep only plays while simulate() runs
+  }
   int timeValue = VolvoDIM.clockToDecimal(3,45,1); //This converts a 12 hour time into a number suitable for setting the clock 
   //The format for the function above is hour, minute, am = 0, pm = 1
   VolvoDIM.setTime(timeValue); //This sets the time on the dim
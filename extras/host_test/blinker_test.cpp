@@ -0,0 +1,111 @@
+/*
+  blinker_test.cpp - Blinker cadence on a fake clock. Records every change
+  of the blinker byte on the wire and checks the lit and dark halves
+  against the configured period and duty, the restart on a mode change,
+  the hazard output and the cadence clamp.
+*/
+#include <VolvoDIM.h>
+#include <stdio.h>
+
+constexpr unsigned long blinkerId = 0xA10408;
+constexpr uint8_t blinkerOff = 0x08;
+constexpr int maxEdges = 64;
+
+struct Edge {
+  unsigned long time;
+  uint8_t value;
+};
+
+VolvoDIM dim(9);
+Edge edges[maxEdges];
+int edgeCount = 0;
+int lastValue = -1;
+int failures = 0;
+
+void onFrame(unsigned long id, const unsigned char* data)
+{
+  if (id != blinkerId || data[7] == lastValue)
+    return;
+  lastValue = data[7];
+  if (edgeCount < maxEdges)
+    edges[edgeCount++] = {hostMillis, data[7]};
+}
+
+void run(unsigned long ms)
+{
+  for (unsigned long i = 0; i < ms; i++) {
+    hostMillis++;
+    dim.simulate();
+  }
+}
+
+void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+bool near(unsigned long actual, unsigned long expected)
+{
+  return actual + 1 >= expected && actual <= expected + 1;
+}
+
+// Switches to mode and checks that the cycle starts lit at once, then
+// alternates lit and dark halves of the given lengths.
+void checkCadence(int right, int left, int hazard, uint8_t lit, unsigned long on, unsigned long off)
+{
+  edgeCount = 0;
+  unsigned long start = hostMillis;
+  dim.setBlinker(right, left, hazard);
+  run(3 * (on + off) + 5);
+  printf("mode %02X:", lit);
+  for (int i = 0; i < edgeCount; i++)
+    printf(" %lu=%02X", edges[i].time - start, edges[i].value);
+  printf("\n");
+  check(edgeCount >= 6, "three full cycles on the wire");
+  check(edgeCount > 0 && edges[0].value == lit && edges[0].time - start <= 1, "mode change restarts the cycle lit");
+  for (int i = 1; i < edgeCount; i++) {
+    bool wasLit = edges[i - 1].value == lit;
+    check(edges[i].value == (wasLit ? blinkerOff : lit), "halves alternate");
+    check(near(edges[i].time - edges[i - 1].time, wasLit ? on : off), "half length");
+  }
+}
+
+int main()
+{
+  hostFakeClock = true;
+  hostFrameHook = onFrame;
+  dim.init();
+  run(100);
+
+  // Default cadence, 750 ms at 50 %.
+  checkCadence(0, 1, 0, 0x0A, 375, 375);
+  check(dim.isBlinkerLit() == (lastValue != blinkerOff), "isBlinkerLit() matches the wire");
+
+  // Switching mode in the dark half restarts lit; hazard lights both sides.
+  dim.setBlinkerCadence(1000, 30);
+  run(500);
+  check(!dim.isBlinkerLit(), "in the dark half before the switch");
+  checkCadence(0, 0, 1, 0x0E, 300, 700);
+  checkCadence(1, 0, 0, 0x0C, 300, 700);
+
+  unsigned long start = hostMillis;
+  dim.setBlinker(0, 1, 0);
+  run(400);
+  check(near(dim.getBlinkerPhase(), hostMillis - start), "phase counts from the mode change");
+
+  // Periods beyond 16 bits clamp rather than wrap (70000 would become 4464).
+  dim.setBlinkerCadence(70000);
+  run(5000);
+  printf("phase after 5.4 s at 70000 ms: %u\n", dim.getBlinkerPhase());
+  check(near(dim.getBlinkerPhase(), hostMillis - start), "cadence clamped to 65535 ms");
+
+  dim.setBlinker(0, 0, 0);
+  run(50);
+  check(lastValue == blinkerOff && !dim.isBlinkerLit(), "lamps off");
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+/*
+  bus_health_test.cpp - Outage detection and recovery on a fake clock. A
+  short error-passive dropout must be reported as one outage of the right
+  length, and so must a bus-off that outlasts the controller restart, even
+  though the restart clears the error registers while the bus is still
+  broken.
+*/
+#include <VolvoDIM.h>
+#include <stdio.h>
+
+constexpr uint8_t regTec = 0x1C;
+constexpr uint8_t regEflg = 0x2D;
+
+VolvoDIM dim(9);
+unsigned int lostCount = 0;
+unsigned int recoveredCount = 0;
+unsigned long recoveredDuration = 0;
+int failures = 0;
+
+void onLost()
+{
+  lostCount++;
+}
+
+void onRecovered(unsigned long outageMs)
+{
+  recoveredCount++;
+  recoveredDuration = outageMs;
+}
+
+void run(unsigned long ms)
+{
+  for (unsigned long i = 0; i < ms; i++) {
+    hostMillis++;
+    dim.simulate();
+  }
+}
+
+void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+int main()
+{
+  hostFakeClock = true;
+  dim.init();
+  dim.setBusCallbacks(onLost, onRecovered);
+  run(200);
+  check(dim.isBusOk() && lostCount == 0, "bus healthy after init");
+
+  // DIM loses power: frames go unacknowledged and the controller goes error-passive.
+  hostBusBroken = true;
+  hostRegisters[regTec] = 128;
+  hostRegisters[regEflg] = 0x10;
+  run(500);
+  check(!dim.isBusOk() && lostCount == 1, "error-passive dropout detected");
+  hostBusBroken = false;
+  hostRegisters[regTec] = 0;
+  hostRegisters[regEflg] = 0;
+  run(100);
+  printf("dropout: %lu ms\n", recoveredDuration);
+  check(recoveredCount == 1, "dropout recovered once");
+  check(recoveredDuration >= 450 && recoveredDuration <= 550, "dropout duration");
+
+  // Bus-off for longer than the restart time; begin() wipes EFLG and TEC.
+  unsigned int resets = hostControllerResets;
+  hostBusBroken = true;
+  hostRegisters[regTec] = 255;
+  hostRegisters[regEflg] = 0x20;
+  run(3000);
+  printf("bus-off: %u restarts, %u outages, %u recoveries\n",
+         hostControllerResets - resets, dim.getBusOutageCount(), recoveredCount);
+  check(hostControllerResets > resets, "controller restarted");
+  check(!dim.isBusOk(), "bus still down after the restart");
+  check(lostCount == 2 && dim.getBusOutageCount() == 2, "bus-off counted as one outage");
+  check(recoveredCount == 1, "no recovery while the bus is broken");
+  hostBusBroken = false;
+  run(100);
+  printf("bus-off: %lu ms\n", recoveredDuration);
+  check(dim.isBusOk() && recoveredCount == 2, "bus-off recovered");
+  check(recoveredDuration >= 2950 && recoveredDuration <= 3050, "bus-off duration");
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
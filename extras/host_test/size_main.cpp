@@ -0,0 +1,17 @@
+/*
+  size_main.cpp - The power_up example as a host program, used by the size
+  report to see what a minimal sketch pulls in from the library.
+*/
+#include <VolvoDIM.h>
+#include <stdio.h>
+
+VolvoDIM dim(9);
+
+int main()
+{
+  dim.init();
+  for (int i = 0; i < 100; i++)
+    dim.simulate();
+  printf("%u\n", dim.getRamUsage());
+  return 0;
+}
@@ -0,0 +1,76 @@
+/*
+  Arduino.h - Minimal host stand-in for building VolvoDIMLib off-target.
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+#define PROGMEM
+inline uint8_t pgm_read_byte(const void* p) { return *(const uint8_t*)p; }
+inline uint16_t pgm_read_word(const void* p) { return *(const uint16_t*)p; }
+inline unsigned long pgm_read_dword(const void* p) { return *(const unsigned long*)p; }
+inline void* memcpy_P(void* dest, const void* src, size_t n) { return memcpy(dest, src, n); }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+long random(long low, long high);
+
+// Host tests set hostFakeClock to drive millis() from hostMillis.
+extern bool hostFakeClock;
+extern unsigned long hostMillis;
+
+// Just enough of Arduino's String for the custom text formatter.
+class String
+{
+  public:
+    String(const char* text = "") : s(text) {}
+    String(const std::string& text) : s(text) {}
+    void trim()
+    {
+      size_t first = s.find_first_not_of(' ');
+      if (first == std::string::npos) {
+        s.clear();
+        return;
+      }
+      s = s.substr(first, s.find_last_not_of(' ') - first + 1);
+    }
+    unsigned int length() const { return s.size(); }
+    int indexOf(char c, unsigned int from) const
+    {
+      size_t pos = s.find(c, from);
+      return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return String(s.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const { return String(s.substr(from, to - from)); }
+    String& operator+=(const String& other) { s += other.s; return *this; }
+    String& operator+=(const char* other) { s += other; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.s); }
+    void toCharArray(char* buf, unsigned int n) const
+    {
+      strncpy(buf, s.c_str(), n - 1);
+      buf[n - 1] = 0;
+    }
+
+  private:
+    std::string s;
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*
+  SPI.h - Host stand-in; transfers read back from hostRegisters.
+*/
+#ifndef SPI_h
+#define SPI_h
+
+#include "Arduino.h"
+
+extern uint8_t hostRegisters[256];
+
+struct SPISettings
+{
+  SPISettings() {}
+  SPISettings(unsigned long /* clock */, int /* order */, int /* mode */) {}
+};
+
+// Models MCP2515 READ transactions: instruction, address, then data.
+class SPIClass
+{
+  public:
+    void begin() {}
+    void beginTransaction(SPISettings /* settings */) { step = 0; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t value)
+    {
+      step++;
+      if (step == 2)
+        address = value;
+      return step >= 3 ? hostRegisters[(uint8_t)(address + step - 3)] : 0;
+    }
+
+  private:
+    int step = 0;
+    uint8_t address = 0;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,50 @@
+/*
+  host.cpp - Host implementations of the Arduino calls VolvoDIMLib uses.
+  Time comes from a steady clock unless hostFakeClock is set, in which case
+  millis() returns hostMillis and delay() advances it.
+*/
+#include "Arduino.h"
+#include "SPI.h"
+#include "mcp2515_can.h"
+#include <chrono>
+#include <thread>
+
+SPIClass SPI;
+uint8_t hostRegisters[256];
+void (*hostFrameHook)(unsigned long id, const unsigned char* data) = NULL;
+bool hostBusBroken = false;
+unsigned int hostControllerResets = 0;
+bool hostFakeClock = false;
+unsigned long hostMillis = 0;
+
+static const std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+  if (hostFakeClock)
+    return hostMillis;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+unsigned long micros()
+{
+  if (hostFakeClock)
+    return hostMillis * 1000;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostStart).count();
+}
+
+void delay(unsigned long ms)
+{
+  if (hostFakeClock)
+    hostMillis += ms;
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void pinMode(int /* pin */, int /* mode */) {}
+void digitalWrite(int /* pin */, int /* value */) {}
+
+long random(long low, long high)
+{
+  return low + rand() % (high - low);
+}
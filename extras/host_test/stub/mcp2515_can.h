@@ -0,0 +1,47 @@
+/*
+  mcp2515_can.h - Host stand-in for the CAN_BUS_Shield driver. Sent frames
+  go to hostFrameHook and EFLG is read from hostRegisters. begin() resets
+  the registers like the real chip; while hostBusBroken is set no frame is
+  acknowledged and sends time out.
+*/
+#ifndef mcp2515_can_h
+#define mcp2515_can_h
+
+#include "mcp_can.h"
+#include <SPI.h>
+
+extern void (*hostFrameHook)(unsigned long id, const unsigned char* data);
+extern bool hostBusBroken;
+extern unsigned int hostControllerResets;
+
+class mcp2515_can
+{
+  public:
+    mcp2515_can(int csPin) : SPICS(csPin), pSPI(&SPI) {}
+    unsigned char begin(int /* speed */, int /* clock */)
+    {
+      memset(hostRegisters, 0, sizeof(hostRegisters));
+      hostControllerResets++;
+      return CAN_OK;
+    }
+    unsigned char sendMsgBuf(unsigned long id, unsigned char /* ext */, unsigned char /* len */, const unsigned char* buf)
+    {
+      if (hostBusBroken)
+        return CAN_SENDMSGTIMEOUT;
+      if (hostFrameHook)
+        hostFrameHook(id, buf);
+      return CAN_OK;
+    }
+    unsigned char checkError(uint8_t* errPtr = NULL)
+    {
+      if (errPtr)
+        *errPtr = hostRegisters[0x2D];
+      return hostRegisters[0x2D] ? CAN_CTRLERROR : CAN_OK;
+    }
+
+  protected:
+    unsigned char SPICS;
+    SPIClass* pSPI;
+};
+
+#endif
@@ -0,0 +1,15 @@
+/*
+  mcp_can.h - Host stand-in for the CAN_BUS_Shield constants.
+*/
+#ifndef mcp_can_h
+#define mcp_can_h
+
+#include "Arduino.h"
+
+#define CAN_OK 0
+#define CAN_CTRLERROR 5
+#define CAN_SENDMSGTIMEOUT 7
+#define CAN_125KBPS 13
+#define MCP_16MHz 1
+
+#endif
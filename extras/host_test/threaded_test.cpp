@@ -0,0 +1,115 @@
+/*
+  threaded_test.cpp - Producer/transmitter stress test for the threaded
+  build. One thread flips the RPM frame between two complete states and
+  publishes as fast as it can while another runs transmit(); every frame
+  that reaches the stub driver is checked for a mix of the two states, and
+  the library's publish-to-wire latency must stay bounded.
+
+  Built with -DVOLVODIM_ENABLE_THREADED=1 by "make test" (and under
+  ThreadSanitizer by "make tsan").
+*/
+#include <VolvoDIM.h>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+constexpr unsigned long rpmId = 0x2803008;
+constexpr unsigned long speedId = 0x217FFC;
+constexpr unsigned long runTime = 2000;         // ms of load per phase
+constexpr unsigned long maxLatency = 50000;     // us, two keep-alive periods plus slack
+
+VolvoDIM dim(9);
+std::atomic<bool> running(true);
+std::atomic<bool> mileageFrozen(false);
+
+// Written only from the transmit thread through the frame hook.
+unsigned long rpmFrames = 0;
+unsigned long tornFrames = 0;
+unsigned long speedFrames = 0;
+int frozenCounter = -1;
+unsigned long counterMismatches = 0;
+
+void onFrame(unsigned long id, const unsigned char* data)
+{
+  if (id == rpmId) {
+    // Both states set RPM and brightness together: 0/0 or 8000/255.
+    bool rpmZero = data[6] == 0 && data[7] == 0;
+    bool brightnessZero = data[2] == 0;
+    rpmFrames++;
+    if (rpmZero != brightnessZero)
+      tornFrames++;
+  } else if (id == speedId && mileageFrozen) {
+    speedFrames++;
+    if (frozenCounter < 0)
+      frozenCounter = data[7];
+    else if (data[7] != frozenCounter)
+      counterMismatches++;
+  }
+}
+
+void transmitLoop()
+{
+  while (running)
+    dim.transmit();
+}
+
+void produce(unsigned long ms)
+{
+  auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  bool high = false;
+  while (std::chrono::steady_clock::now() < end) {
+    high = !high;
+    dim.setRpm(high ? 8000 : 0);
+    dim.setTotalBrightness(high ? 255 : 0);
+    dim.setBlinker(high, 0, 0);
+    dim.isBlinkerLit();
+    dim.getBlinkerPhase();
+    dim.publish();
+  }
+}
+
+int main()
+{
+  hostFrameHook = onFrame;
+  dim.init();
+  dim.setSpeed(255);
+  dim.setRpm(0);
+  dim.setTotalBrightness(0);
+  dim.publish();
+
+  std::thread transmitter(transmitLoop);
+  produce(runTime);
+  // Park the odometer: the counter must keep going out unchanged.
+  dim.enableMilageTracking(0);
+  dim.publish();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  mileageFrozen = true;
+  produce(runTime);
+  running = false;
+  transmitter.join();
+
+  unsigned long latency = dim.getMaxPublishLatency();
+  printf("rpm frames %lu, torn %lu, max latency %lu us\n", rpmFrames, tornFrames, latency);
+  printf("speed frames %lu after parking, counter %d, changed %lu\n", speedFrames, frozenCounter, counterMismatches);
+
+  int failures = 0;
+  if (rpmFrames == 0) {
+    printf("FAIL: no RPM frames sent\n");
+    failures++;
+  }
+  if (tornFrames > 0) {
+    printf("FAIL: torn RPM frames\n");
+    failures++;
+  }
+  if (latency == 0 || latency > maxLatency) {
+    printf("FAIL: publish-to-wire latency outside 1..%lu us\n", maxLatency);
+    failures++;
+  }
+  if (speedFrames == 0 || frozenCounter <= 0 || counterMismatches > 0) {
+    printf("FAIL: mileage counter not held on the speed frame\n");
+    failures++;
+  }
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,61 @@
+#!/bin/sh
+# size_report.sh - Code and RAM use of VolvoDIMLib per feature configuration.
+#
+# Builds the power_up example on the host (extras/host_test/size_main.cpp)
+# once per configuration with section garbage collection, then sums the
+# library symbols that survive the link:
+#
+#   code    functions kept in the final program
+#   const   read-only tables (PROGMEM on AVR)
+#   ram     initialised and zeroed globals
+#   state   getRamUsage() at run time: static RAM of the whole host
+#           program, C runtime included
+#
+# Figures are for the host compiler (x86-64 pointers and long are 8 bytes),
+# so use them to compare configurations, not as AVR absolutes. Run from the
+# library root:
+#
+#   extras/size_report.sh > extras/size_report.txt
+
+CXX="${CXX:-g++}"
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+HOST="$ROOT/extras/host_test"
+OUT="${TMPDIR:-/tmp}/volvodim_size"
+CXXFLAGS="-std=gnu++11 -Os -ffunction-sections -fdata-sections -Wall -Wextra -I$HOST/stub -I$ROOT/src"
+
+mkdir -p "$OUT"
+"$CXX" $CXXFLAGS -c "$HOST/stub/host.cpp" -o "$OUT/host.o" || exit 1
+
+report() {
+  name="$1"
+  flags="$2"
+  "$CXX" $CXXFLAGS $flags -c "$ROOT/src/VolvoDIM.cpp" -o "$OUT/lib.o" || exit 1
+  "$CXX" $CXXFLAGS $flags -c "$HOST/size_main.cpp" -o "$OUT/main.o" || exit 1
+  "$CXX" -Wl,--gc-sections "$OUT/main.o" "$OUT/lib.o" "$OUT/host.o" -o "$OUT/prog" || exit 1
+  state="$("$OUT/prog")"
+  nm --defined-only "$OUT/lib.o" | awk '{ print $3 }' | sort -u > "$OUT/lib.syms"
+  nm -S -t d --defined-only "$OUT/prog" | awk -v name="$name" -v state="${state:--}" '
+    NR == FNR { lib[$1] = 1; next }
+    NF == 4 && ($4 in lib) {
+      size = $2 + 0
+      type = toupper($3)
+      if (type == "T" || type == "W") code += size
+      else if (type == "R" || type == "V") rodata += size
+      else if (type == "D") { rodata += size; ram += size }
+      else if (type == "B") ram += size
+    }
+    END { printf "%-16s %8d %8d %8d %8s\n", name, code, rodata, ram, state }
+  ' "$OUT/lib.syms" - 
+}
+
+ALL_OFF="-DVOLVODIM_ENABLE_TEXT=0 -DVOLVODIM_ENABLE_ODOMETER=0 -DVOLVODIM_ENABLE_WARNINGS=0 -DVOLVODIM_ENABLE_GATEWAY=0 -DVOLVODIM_ENABLE_INSTRUMENTATION=0 -DVOLVODIM_ENABLE_ANIMATION=0"
+
+printf "%-16s %8s %8s %8s %8s\n" "configuration" "code" "const" "ram" "state"
+report "full"            ""
+report "no text"         "-DVOLVODIM_ENABLE_TEXT=0"
+report "no odometer"     "-DVOLVODIM_ENABLE_ODOMETER=0"
+report "no warnings"     "-DVOLVODIM_ENABLE_WARNINGS=0"
+report "no gateway"      "-DVOLVODIM_ENABLE_GATEWAY=0"
+report "no instrument."  "-DVOLVODIM_ENABLE_INSTRUMENTATION=0"
+report "no animation"    "-DVOLVODIM_ENABLE_ANIMATION=0"
+report "power-up only"   "$ALL_OFF"
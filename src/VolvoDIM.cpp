@@ -6,41 +6,60 @@
 #include "VolvoDIM.h"
 #ifdef ARDUINO_SAMD_VARIANT_COMPLIANCE
 #endif
+#if VOLVODIM_ENABLE_THREADED
+#include <atomic>
+#include <mutex>
+// State written on one thread and read on the other.
+#define VOLVODIM_SHARED(type) std::atomic<type>
+#else
+#define VOLVODIM_SHARED(type) type
+#endif
 
-// Create a CAN object using the provided CS pin.
-mcp2515_can CAN(0);
-int _relayPin = 0;
+// mcp2515_can has no accessor for the error counters; this exposes a
+// register read over the driver's own SPI bus and CS pin.
+class VolvoDIMCan : public mcp2515_can
+{
+  public:
+    VolvoDIMCan(int csPin) : mcp2515_can(csPin) {}
+    unsigned char readRegister(unsigned char reg)
+    {
+      pSPI->beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));  // Same settings as mcp2515_can.cpp
+      digitalWrite(SPICS, LOW);
+      pSPI->transfer(0x03);  // MCP2515 READ instruction
+      pSPI->transfer(reg);
+      unsigned char value = pSPI->transfer(0x00);
+      digitalWrite(SPICS, HIGH);
+      pSPI->endTransaction();
+      return value;
+    }
+};
 
-VolvoDIM::VolvoDIM(int SPI_CS_PIN, int relayPin) {
-  mcp2515_can temp_CAN(SPI_CS_PIN);
-  CAN = temp_CAN;
-  _relayPin = relayPin;
-  
-  // Initialize parking brake relay control pin (digital pin 7)
-  _parkingBrakePin = 7;
-  pinMode(_parkingBrakePin, OUTPUT);
-  // Set default state: relay off (assuming active low for parking brake)
-  digitalWrite(_parkingBrakePin, HIGH);
-}
+// Create a CAN object using the provided CS pin.
+VolvoDIMCan CAN(0);
+uint8_t _relayPin = 0;
+#if VOLVODIM_ENABLE_WARNINGS
+constexpr uint8_t parkingBrakePin = 7;  // Parking brake relay, active low
+#endif
 
 // Global variables and constants
 bool enableSerialErrMsg = false;
-int genCnt = 0;
-int cnt = 0;
 constexpr int listLen = 14;
-char* customTextMessage = "";
-int startUpWait = 0;
-int customMessageCnt = 0, customTextChanged = 0;
-int mileageCounter = 0, mileagePace = 0, genSpeed = 0;
-int mileageEnabled = 1;
+constexpr int workingLen = 12;  // Slots from here on never change and are sent straight from flash
+#if VOLVODIM_ENABLE_TEXT
+const char* customTextMessage = "";
+uint8_t customMessageCnt = 0;
+bool customTextChanged = false;
+#endif
+#if VOLVODIM_ENABLE_ODOMETER
+bool startUpWait = false;
+uint8_t mileageCounter = 0;  // Wraps like the DIM's own 8-bit counter
+VOLVODIM_SHARED(uint8_t) genSpeed(0);
+VOLVODIM_SHARED(bool) mileageEnabled(true);
 #define CALIBRATION_FACTOR 830.0  // Final calibration factor for the odometer takes 1min 56 seconds 70 ms to cover 1 mile at 64mph.
 unsigned long lastUpdateTimeGlobal = 0;
 float mileageAccumulatorGlobal = 0.0;
-int carConCnt = 0;
-int configCnt = 0;
-int blinkerInterval = 0;
+#endif
 unsigned char stmp[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-unsigned long address;
 
 
 // Array indices for defaultData
@@ -50,66 +69,254 @@ constexpr int arrCoolant  = 2;  // Coolant/OutdoorTemp, CAN ID: 0x3C01428
 constexpr int arrTime     = 3;  // Time/GasTank (time and fuel), CAN ID: 0x381526C
 constexpr int arrBrakes   = 4;  // Brake system keep alive, CAN ID: 0x3600008
 constexpr int arrBlinker  = 5;  // Blinker, CAN ID: 0xA10408
-constexpr int arrAntiSkid = 6;  // Anti-Skid, CAN ID: 0x2006428
-constexpr int arrAirbag   = 7;  // Airbag Light, CAN ID: 0x1A0600A
-constexpr int arr4c       = 8;  // 4C keep alive, CAN ID: 0x2616CFC
-constexpr int arrConfig   = 9;  // Car Config, CAN ID: 0x1017FFC
-constexpr int arrGear     = 10; // Gear Position, CAN ID: 0x3200408
-constexpr int arrDmWindow = 11; // Dim Message Window, CAN ID: 0x02A0240E
-constexpr int arrDmMessage= 12; // Dim Message Content, CAN ID: 0x1800008
-constexpr int arrDisplay  = 13; // Display Rotate OEM, CAN ID: 0x0131726C
+constexpr int arrAirbag   = 6;  // Airbag Light, CAN ID: 0x1A0600A
+constexpr int arr4c       = 7;  // 4C keep alive, CAN ID: 0x2616CFC
+constexpr int arrConfig   = 8;  // Car Config, CAN ID: 0x1017FFC
+constexpr int arrGear     = 9;  // Gear Position, CAN ID: 0x3200408
+constexpr int arrDmWindow = 10; // Dim Message Window, CAN ID: 0x02A0240E
+constexpr int arrDisplay  = 11; // Display Rotate OEM, CAN ID: 0x0131726C
+constexpr int arrAntiSkid = 12; // Anti-Skid, CAN ID: 0x2006428 (constant)
+constexpr int arrDmMessage= 13; // Dim Message Content, CAN ID: 0x1800008 (constant)
 
 // Address list for CAN messages.
-constexpr unsigned long addrLi[listLen] = {
+const unsigned long addrLi[listLen] PROGMEM = {
   0x217FFC, 0x2803008, 0x3C01428, 0x381526C, 0x3600008,
-  0xA10408, 0x2006428, 0x1A0600A, 0x2616CFC, 0x1017FFC,
-  0x3200408, 0x02A0240E, 0x1800008, 0x131726C
+  0xA10408, 0x1A0600A, 0x2616CFC, 0x1017FFC, 0x3200408,
+  0x02A0240E, 0x131726C, 0x2006428, 0x1800008
 };
 
-// Default data for each message slot.
-unsigned char defaultData[listLen][8] = {
+// Default data for each message slot, copied into defaultData by the constructor.
+const unsigned char defaultFrames[listLen][8] PROGMEM = {
   {0x01, 0xEB, 0x00, 0xD8, 0xF0, 0x58, 0x00, 0x00}, // 0: Speed/KeepAlive
   {0xFF, 0xE1, 0xFF, 0xFF, 0xFF, 0xCF, 0x00, 0x00}, // 1: RPM/Backlights
   {0xC0, 0x80, 0x51, 0x89, 0x0E, 0x57, 0x00, 0x00}, // 2: Coolant/OutdoorTemp
   {0x00, 0x01, 0x05, 0xBC, 0x05, 0xA0, 0x40, 0x40}, // 3: Time/GasTank
   {0x00, 0x00, 0xB0, 0x60, 0x30, 0x00, 0x00, 0x00}, // 4: Brake system keep alive
   {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08}, // 5: Blinker
-  {0x01, 0xE3, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00}, // 6: Anti-Skid
-  {0x00, 0x00, 0x00, 0x00, 0x00, 0xBE, 0x49, 0x00}, // 7: Airbag Light
-  {0x0B, 0x42, 0x00, 0x00, 0xFD, 0x1F, 0x00, 0xFF}, // 8: 4C keep alive
-  {0x01, 0x0F, 0xF7, 0xFA, 0x00, 0x00, 0x00, 0xC0}, // 9: Car Config
-  {0x11, 0xDE, 0x53, 0x00, 0x24, 0x00, 0x10, 0x00}, // 10: Gear Position
-  {0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x35}, // 11: Dim Message Window
-  {0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00}, // 12: Dim Message Content
-  {0xCF, 0xEB, 0x80, 0xA2, 0xF0, 0xAA, 0x00, 0xAA}  // 13: Display Rotate OEM
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0xBE, 0x49, 0x00}, // 6: Airbag Light
+  {0x0B, 0x42, 0x00, 0x00, 0xFD, 0x1F, 0x00, 0xFF}, // 7: 4C keep alive
+  {0x01, 0x0F, 0xF7, 0xFA, 0x00, 0x00, 0x00, 0xC0}, // 8: Car Config
+  {0x11, 0xDE, 0x53, 0x00, 0x24, 0x00, 0x10, 0x00}, // 9: Gear Position
+  {0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x35}, // 10: Dim Message Window
+  {0xCF, 0xEB, 0x80, 0xA2, 0xF0, 0xAA, 0x00, 0xAA}, // 11: Display Rotate OEM
+  {0x01, 0xE3, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00}, // 12: Anti-Skid
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00}  // 13: Dim Message Content
+};
+
+// Working copy of the slots the setters and generators modify.
+unsigned char defaultData[workingLen][8];
+
+// Frames the scheduler transmits from. This is defaultData itself unless
+// the threaded mode is enabled, in which case it is the transmit thread's
+// snapshot buffer.
+unsigned char (*txData)[8] = defaultData;
+
+#if VOLVODIM_ENABLE_THREADED
+// ------------------------- Snapshot State -------------------------
+//
+// Triple buffer between publish() and transmit(). Each side owns one buffer
+// outright; the third is swapped through latestSnapshot, so publishing and
+// acquiring are single atomic exchanges and a frame is never read while it
+// is being written.
+constexpr uint8_t snapshotFresh = 0x04;  // Set in latestSnapshot until transmit() takes it
+unsigned char snapshots[3][workingLen][8];
+unsigned long snapshotSlotStamp[3][workingLen];  // Per slot, micros() of its last change
+std::atomic<uint8_t> latestSnapshot(2);
+uint8_t producerSnapshot = 0;
+uint8_t consumerSnapshot = 1;
+uint16_t publishedSignature[workingLen];         // Producer: slot signatures last published
+unsigned long slotChangeStamp[workingLen];       // Producer: micros() each slot last changed
+unsigned long pendingSlotStamp[workingLen];      // Transmitter: change stamps taken from snapshots
+uint16_t latencyPending = 0;                     // Transmitter: slots whose change is not on the wire yet
+VOLVODIM_SHARED(unsigned long) lastPublishLatency(0);
+VOLVODIM_SHARED(unsigned long) maxPublishLatency(0);
+std::mutex canMutex;                     // Serialises SPI access between the two threads
+#endif
+
+static inline unsigned long slotAddress(int slot)
+{
+  return pgm_read_dword(&addrLi[slot]);
+}
+
+// ------------------------- Frame Scheduler State -------------------------
+//
+// Every slot is sent on its own period. The period slides from the slot's
+// keep-alive period down to its fast period as the signal keeps changing,
+// and is stretched back towards keep-alive when the bus is over budget.
+
+// Fastest period (ms) for each slot while its signal is moving.
+const uint8_t fastPeriod[listLen] PROGMEM = {
+  10, 10, 20, 20, 50, 20, 50, 50, 50, 20, 50, 50, 50, 50
+};
+
+// Period (ms) each slot falls back to once its signal is static.
+const uint8_t keepAlivePeriod[listLen] PROGMEM = {
+  20, 20, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50, 50
+};
+
+// Bytes of each working slot carrying host signals (bit n = byte n). Bytes
+// rewritten by the frame generators (mileage counter, SRS/CC/temp jitter)
+// are excluded.
+const uint8_t signalMask[workingLen] PROGMEM = {
+  0x7F, 0xFF, 0xF8, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0x3F, 0xFF, 0xFF, 0xFF
+};
+
+uint16_t lastSentSignature[workingLen];  // Checksum of the signal bytes last sent
+uint16_t lastSentTime[listLen];          // Low 16 bits of millis(); periods are far shorter
+uint8_t activity[listLen];               // Decaying measure of how often each slot changes, 0-252
+
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+constexpr unsigned long busBitRate = 125000;  // Matches CAN_125KBPS in init()
+constexpr unsigned long frameBits = 150;      // 29-bit ID, 8 data bytes, framing and typical stuffing
+constexpr unsigned long busLoadWindow = 250;  // Utilisation is averaged over this many ms
+VOLVODIM_SHARED(unsigned long) busBitsSent(0);
+unsigned long busLoadWindowStart = 0;
+VOLVODIM_SHARED(uint8_t) busUtilisation(0);  // Percent of bus capacity used over the last window
+VOLVODIM_SHARED(uint8_t) busLoadBudget(70);  // Percent of bus capacity the scheduler may use
+#endif
+
+// ------------------------- Blinker State -------------------------
+//
+// setBlinker() only selects which lamps flash; simulate() generates the
+// on/off cadence locally so the host does not have to stream it.
+constexpr uint8_t blinkerOff = 0x08;               // Blinker byte with no lamps lit
+VOLVODIM_SHARED(uint8_t) blinkerMode(blinkerOff);  // Blinker byte for the lit half of the cycle
+VOLVODIM_SHARED(uint16_t) blinkerPeriod(750);      // ms per on/off cycle, 0 for steady lamps
+VOLVODIM_SHARED(uint8_t) blinkerDuty(50);          // Percent of the cycle the lamps are lit
+uint8_t blinkerShownMode = blinkerOff;             // Mode genBlinking() is currently cycling
+VOLVODIM_SHARED(unsigned long) blinkerStart(0);    // millis() when that mode was picked up
+VOLVODIM_SHARED(bool) blinkerLit(false);           // Whether the last generated frame had lamps lit
+
+// ------------------------- Animation State -------------------------
+//
+// Each channel plays a PROGMEM keyframe table against millis(). The
+// animations are evaluated at the start of every simulate() call and feed
+// the normal setters, so the scheduler picks the changes up like any other.
+#if VOLVODIM_ENABLE_ANIMATION
+struct AnimationState {
+  const VolvoDIM::Keyframe* frames;  // NULL when the channel is idle
+  uint8_t count;
+  bool loop;
+  unsigned long start;
+  int16_t lastValue;
+};
+AnimationState animations[VolvoDIM::ANIM_CHANNELS];
+bool applyingAnimation = false;  // Set while an animation drives the setters
+
+// Startup sweep used by sweepGauges(): up to full scale, hold, back to zero.
+const VolvoDIM::Keyframe sweepRpmFrames[] PROGMEM = {
+  {0, 0, VolvoDIM::EASE_STEP},
+  {600, 7900, VolvoDIM::EASE_IN_OUT},
+  {900, 7900, VolvoDIM::EASE_LINEAR},
+  {1500, 0, VolvoDIM::EASE_IN_OUT}
+};
+const VolvoDIM::Keyframe sweepSpeedFrames[] PROGMEM = {
+  {0, 0, VolvoDIM::EASE_STEP},
+  {600, 160, VolvoDIM::EASE_IN_OUT},
+  {900, 160, VolvoDIM::EASE_LINEAR},
+  {1500, 0, VolvoDIM::EASE_IN_OUT}
 };
+#endif
+
+// ------------------------- Bus Health State -------------------------
+//
+// The MCP2515 error counters are polled every busCheckPeriod. Once the
+// controller goes error-passive or bus-off (typically because the DIM lost
+// power and stopped acknowledging frames) the scheduler pauses and a single
+// probe frame is sent per check. The bus counts as back only once the
+// counters have fallen back and the last probe was acknowledged; a
+// controller restart clears the counters even if the bus is still broken.
+// The SRS/4C handshake is then replayed one frame per tick.
+constexpr unsigned char regTec = 0x1C;      // MCP2515 transmit error counter
+constexpr unsigned char regRec = 0x1D;      // MCP2515 receive error counter
+constexpr unsigned char eflgTxBusOff = 0x20;
+constexpr unsigned char eflgTxPassive = 0x10;
+constexpr unsigned char eflgRxPassive = 0x08;
+constexpr unsigned long busCheckPeriod = 25;      // ms between error counter reads
+constexpr unsigned long controllerResetTime = 1000; // ms of bus-off before the controller is restarted
+constexpr unsigned long handshakeSpacing = 15;  // ms between handshake frames
+
+// Handshake frames sent by initSRS() (first srsHandshakeLen) then init4C().
+constexpr int handshakeLen = 8;
+constexpr int srsHandshakeLen = 4;
+const unsigned char handshakeData[handshakeLen][8] PROGMEM = {
+  {0xC0, 0x00, 0x00, 0x00, 0x00, 0xBC, 0xDB, 0x80},
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0xBC, 0xDB, 0x80},
+  {0xC0, 0x00, 0x00, 0x00, 0x00, 0xBC, 0xC9, 0x80},
+  {0x80, 0x00, 0x00, 0x00, 0x00, 0xBC, 0xC9, 0x80},
+  {0x09, 042, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00},
+  {0x09, 042, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00},
+  {0x0B, 042, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00},
+  {0x0B, 042, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00}
+};
+
+unsigned char errorFlags = 0;
+VOLVODIM_SHARED(bool) busDown(false);
+unsigned long lastBusCheck = 0;
+unsigned long outageStart = 0;
+unsigned long lastControllerReset = 0;
+bool probeAcked = false;               // Last probe left the controller acknowledged
+uint8_t handshakeStep = handshakeLen;  // handshakeLen when no replay is pending
+unsigned long lastHandshakeTime = 0;
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+VOLVODIM_SHARED(uint8_t) txErrorCount(0);
+VOLVODIM_SHARED(uint8_t) rxErrorCount(0);
+VOLVODIM_SHARED(unsigned long) lastOutageDuration(0);
+VOLVODIM_SHARED(unsigned int) busOutageCount(0);
+void (*busLostCallback)() = NULL;
+void (*busRecoveredCallback)(unsigned long outageMs) = NULL;
+#endif
+
+VolvoDIM::VolvoDIM(int SPI_CS_PIN, int relayPin) {
+  VolvoDIMCan temp_CAN(SPI_CS_PIN);
+  CAN = temp_CAN;
+  _relayPin = relayPin;
+  memcpy_P(defaultData, defaultFrames, sizeof(defaultData));
+#if VOLVODIM_ENABLE_THREADED
+  for (int i = 0; i < 3; i++)
+    memcpy(snapshots[i], defaultData, sizeof(defaultData));
+  txData = snapshots[consumerSnapshot];
+#endif
+  
+#if VOLVODIM_ENABLE_WARNINGS
+  // Initialize parking brake relay control pin
+  pinMode(parkingBrakePin, OUTPUT);
+  // Set default state: relay off (assuming active low for parking brake)
+  digitalWrite(parkingBrakePin, HIGH);
+#endif
+}
 
 // ---------------------- Message Transmission Functions ----------------------
 
-void VolvoDIM::sendMsgWrapper(unsigned long wId, unsigned char *wBuf)
+unsigned char VolvoDIM::sendMsgWrapper(unsigned long wId, unsigned char *wBuf)
 {
-  CAN.sendMsgBuf(wId, 1, 8, wBuf);
+#if VOLVODIM_ENABLE_THREADED
+  std::lock_guard<std::mutex> lock(canMutex);
+#endif
+  unsigned char status = CAN.sendMsgBuf(wId, 1, 8, wBuf);
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+  busBitsSent += frameBits;
+#endif
+  return status;
+}
+
+void VolvoDIM::sendHandshakeFrame(int step)
+{
+  unsigned char temp[8];
+  memcpy_P(temp, handshakeData[step], sizeof(temp));
+  sendMsgWrapper(slotAddress(step < srsHandshakeLen ? arrAirbag : arr4c), temp);
 }
 
 void VolvoDIM::initSRS()
 {
-  unsigned char temp[8] = {0xC0, 0x00, 0x00, 0x00, 0x00, 0xBC, 0xDB, 0x80};
-  unsigned long tempAddr = addrLi[arrAirbag];
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  temp[0] = 0x00;
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  temp[0] = 0xC0;
-  temp[6] = 0xC9;
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  temp[0] = 0x80;
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
+  for (int i = 0; i < srsHandshakeLen; i++) {
+    sendHandshakeFrame(i);
+    delay(handshakeSpacing);
+  }
 }
 
-void VolvoDIM::genSRS(long address, byte stmp[])
+#if VOLVODIM_ENABLE_GATEWAY
+unsigned char VolvoDIM::genSRS(long address, byte stmp[])
 {
   int randomNum = random(0, 794);
   if (randomNum < 180) {
@@ -121,37 +328,30 @@ void VolvoDIM::genSRS(long address, byte stmp[])
   } else {
     stmp[0] = 0x80;
   }
-  sendMsgWrapper(address, stmp);
-  delay(15);
+  return sendMsgWrapper(address, stmp);
 }
+#endif
 
 void VolvoDIM::init4C()
 {
-  unsigned char temp[8] = {0x09, 042, 0x00, 0x00, 0x00, 0x50, 0x00, 0x00};
-  unsigned long tempAddr = addrLi[arr4c];
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  temp[0] = 0x0B;
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
-  sendMsgWrapper(tempAddr, temp);
-  delay(15);
+  for (int i = srsHandshakeLen; i < handshakeLen; i++) {
+    sendHandshakeFrame(i);
+    delay(handshakeSpacing);
+  }
 }
 
-void VolvoDIM::genCC(long address, byte stmp[])
+#if VOLVODIM_ENABLE_GATEWAY
+unsigned char VolvoDIM::genCC(long address, byte stmp[])
 {
   int randomNum = random(0, 7);
   if (randomNum > 3) {
     stmp[6] = 0xFF;
     stmp[7] = 0xF3;
   }
-  sendMsgWrapper(address, stmp);
-  delay(15);
+  return sendMsgWrapper(address, stmp);
 }
 
-void VolvoDIM::genTemp(long address, byte stmp[])
+unsigned char VolvoDIM::genTemp(long address, byte stmp[])
 {
   int randomNum = random(0, 133);
   if (randomNum < 16) {
@@ -176,11 +376,12 @@ void VolvoDIM::genTemp(long address, byte stmp[])
   } else {
     stmp[2] = 0x41;
   }
-  sendMsgWrapper(address, stmp);
-  delay(15);
+  return sendMsgWrapper(address, stmp);
 }
+#endif
 
-void VolvoDIM::genMileageAndSpeed() {
+#if VOLVODIM_ENABLE_ODOMETER
+unsigned char VolvoDIM::genMileageAndSpeed() {
     unsigned long currentTime = millis();
     if (lastUpdateTimeGlobal == 0) {
         lastUpdateTimeGlobal = currentTime;
@@ -188,7 +389,7 @@ void VolvoDIM::genMileageAndSpeed() {
     unsigned long deltaMillis = currentTime - lastUpdateTimeGlobal;
     lastUpdateTimeGlobal = currentTime;
     
-    if (mileageEnabled == 1 && startUpWait == 0) {
+    if (mileageEnabled && !startUpWait) {
         float deltaHours = deltaMillis / 3600000.0;
         float distanceIncrement = genSpeed * deltaHours;
         
@@ -200,13 +401,13 @@ void VolvoDIM::genMileageAndSpeed() {
             mileageCounter += rawUnitsToAdd;
             mileageAccumulatorGlobal -= rawUnitsToAdd;
         }
-        if (mileageCounter > 255) {
-            mileageCounter = 0;
-        }
-        defaultData[arrSpeed][7] = mileageCounter;
     }
-    sendMsgWrapper(addrLi[arrSpeed], defaultData[arrSpeed]);
+    // Stamped on every send: in threaded builds txData is a snapshot of
+    // defaultData, which never holds the counter.
+    txData[arrSpeed][7] = mileageCounter;
+    return sendMsgWrapper(slotAddress(arrSpeed), txData[arrSpeed]);
 }
+#endif
 
 void VolvoDIM::powerOn()
 {
@@ -289,6 +490,9 @@ void VolvoDIM::setOutdoorTemp(int oTemp)
 
 void VolvoDIM::setCoolantTemp(int range)
 {
+#if VOLVODIM_ENABLE_ANIMATION
+  releaseAnimation(ANIM_COOLANT);
+#endif
   if (range >= 0 && range <= 55) {
     defaultData[arrCoolant][3] = range + 88;
   } else if (range <= 100) {
@@ -298,7 +502,13 @@ void VolvoDIM::setCoolantTemp(int range)
 
 void VolvoDIM::setSpeed(int carSpeed)
 {
-  genSpeed = carSpeed;
+#if VOLVODIM_ENABLE_ANIMATION
+  releaseAnimation(ANIM_SPEED);
+#endif
+#if VOLVODIM_ENABLE_ODOMETER
+  // The odometer keeps counting past the gauge's range, up to what genSpeed holds.
+  genSpeed = carSpeed < 0 ? 0 : (carSpeed > 255 ? 255 : carSpeed);
+#endif
   if (carSpeed >= 0 && carSpeed <= 160) {
     if (carSpeed <= 40)
       defaultData[arrSpeed][5] = 0x58;
@@ -314,12 +524,14 @@ void VolvoDIM::setSpeed(int carSpeed)
 
 void VolvoDIM::setGasLevel(int level)
 {
+#if VOLVODIM_ENABLE_ANIMATION
+  releaseAnimation(ANIM_FUEL);
+#endif
   if (level >= 0 && level <= 100)
   {
     int value = round(level * 0.62);
     defaultData[arrTime][6] = value;
     defaultData[arrTime][7] = value;
-    sendMsgWrapper(addrLi[arrTime], defaultData[arrTime]);
   }
   else
   {
@@ -331,6 +543,9 @@ void VolvoDIM::setGasLevel(int level)
 }
 
 void VolvoDIM::setRpm(int rpm) {
+#if VOLVODIM_ENABLE_ANIMATION
+  releaseAnimation(ANIM_RPM);
+#endif
   // Clamp rpm between 0 and 8000
   if (rpm < 0)
     rpm = 0;
@@ -351,15 +566,20 @@ void VolvoDIM::setRpm(int rpm) {
 }
 
 
+#if VOLVODIM_ENABLE_WARNINGS
 void VolvoDIM::enableHighBeam(int enabled) {
   if (enabled == 1)
     defaultData[arrRpm][1] = 0xFF;
   else
     defaultData[arrRpm][1] = 0xEA;
 }
+#endif
 
 void VolvoDIM::setTotalBrightness(int value)
 {
+#if VOLVODIM_ENABLE_ANIMATION
+    releaseAnimation(ANIM_BRIGHTNESS);
+#endif
     if (value < 0)
         value = 0;
     else if (value > 255)
@@ -437,6 +657,7 @@ void VolvoDIM::setGearPosInt(int gear)
   }
 }
 
+#if VOLVODIM_ENABLE_TEXT
 // ------------------ Custom Text Display Functions ------------------
 //
 // This helper function formats the input text into a 32‑character string
@@ -450,7 +671,7 @@ String formatTextForDisplay(const char* text) {
   String line2 = "";
   
   int start = 0;
-  while (start < input.length()) {
+  while (start < (int)input.length()) {
     int spaceIdx = input.indexOf(' ', start);
     String word;
     if (spaceIdx == -1) {
@@ -498,9 +719,9 @@ String formatTextForDisplay(const char* text) {
 }
 
 void VolvoDIM::setCustomText(const char* text) {
-  customTextMessage = (char*)text;
+  customTextMessage = text;
   customMessageCnt = 0;
-  customTextChanged = 1;
+  customTextChanged = true;
 }
 
 void VolvoDIM::genCustomText(const char* text) {
@@ -514,7 +735,7 @@ void VolvoDIM::genCustomText(const char* text) {
   // Activate the custom text display command.
   memcpy(stmp, defaultData[arrDmWindow], sizeof(stmp));
   defaultData[arrDmWindow][7] = 0x31;
-  sendMsgWrapper(addrLi[arrDmWindow], stmp);
+  sendMsgWrapper(slotAddress(arrDmWindow), stmp);
   delay(40);
   
   // Send the text via D2 protocol frames.
@@ -524,7 +745,7 @@ void VolvoDIM::genCustomText(const char* text) {
   stmp[0] = 0xA7;
   stmp[1] = 0x00;
   memcpy(&stmp[2], msg, firstChunk);
-  sendMsgWrapper(addrLi[arrDmMessage], stmp);
+  sendMsgWrapper(slotAddress(arrDmMessage), stmp);
   delay(40);
   
   int index = firstChunk;
@@ -536,7 +757,7 @@ void VolvoDIM::genCustomText(const char* text) {
     memset(buffer, ' ', chunkSize);
     memcpy(buffer, &msg[index], copySize);
     memcpy(&stmp[1], buffer, chunkSize);
-    sendMsgWrapper(addrLi[arrDmMessage], stmp);
+    sendMsgWrapper(slotAddress(arrDmMessage), stmp);
     delay(40);
     index += chunkSize;
     seq++;
@@ -545,34 +766,38 @@ void VolvoDIM::genCustomText(const char* text) {
   // Final frame to complete transmission.
   stmp[0] = 0x65;
   memset(&stmp[1], ' ', 7);
-  sendMsgWrapper(addrLi[arrDmMessage], stmp);
+  sendMsgWrapper(slotAddress(arrDmMessage), stmp);
 }
 
 void VolvoDIM::clearCustomText()
 {
   unsigned char clearValues[] = {0xE1, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-  sendMsgWrapper(addrLi[arrDmWindow], clearValues);
+  sendMsgWrapper(slotAddress(arrDmWindow), clearValues);
 }
 
 void VolvoDIM::displayText(const char* text) {
   genCustomText(text);
 }
+#endif
 
+#if VOLVODIM_ENABLE_ODOMETER
 void VolvoDIM::enableMilageTracking(int on){
-  mileageEnabled = on;
+  mileageEnabled = (on != 0);
 }
+#endif
 
 void VolvoDIM::enableDisableDingNoise(int on){
   memcpy(stmp, defaultData[arrTime], sizeof(stmp));
   if(on == 0){
     stmp[1] = 0x30;
-    sendMsgWrapper(addrLi[arrTime], stmp);
+    sendMsgWrapper(slotAddress(arrTime), stmp);
   } else if (on == 1){
     stmp[1] = 0x18;
-    sendMsgWrapper(addrLi[arrTime], stmp);
+    sendMsgWrapper(slotAddress(arrTime), stmp);
   }
 }
 
+#if VOLVODIM_ENABLE_WARNINGS
 void VolvoDIM::enableFog(int enabled)
 {
   if (enabled == 1)
@@ -588,24 +813,81 @@ void VolvoDIM::enableBrake(int enabled)
   else
     defaultData[arrBrakes][3] = 0x60;
 }
+#endif
 
 void VolvoDIM::setBlinker(int right, int left, int hazard) {
   // Priority: hazard > right > left
+  uint8_t mode;
   if (hazard == 1 || (right == 1 && left == 1))
-    defaultData[arrBlinker][7] = 0x0E;
+    mode = 0x0E;
   else if (right == 1)
-    defaultData[arrBlinker][7] = 0x0C;
+    mode = 0x0C;
   else if (left == 1)
-    defaultData[arrBlinker][7] = 0x0A;
+    mode = 0x0A;
   else
-    defaultData[arrBlinker][7] = 0x08;
+    mode = blinkerOff;
+  blinkerMode = mode;
+#if !VOLVODIM_ENABLE_THREADED
+  genBlinking(millis());
+#endif
+}
+
+void VolvoDIM::setBlinkerCadence(int period, int duty)
+{
+  if (period < 0)
+    period = 0;
+  else if ((long)period > 65535L)
+    period = 65535;
+  if (duty < 1)
+    duty = 1;
+  else if (duty > 100)
+    duty = 100;
+  blinkerPeriod = period;
+  blinkerDuty = duty;
 }
 
+unsigned int VolvoDIM::getBlinkerPhase()
+{
+  // Both read only the shared state genBlinking() leaves behind, never the
+  // frames the transmit thread is working on.
+  unsigned long period = blinkerPeriod;
+  if (period == 0)
+    return 0;
+  return (millis() - blinkerStart) % period;
+}
+
+bool VolvoDIM::isBlinkerLit()
+{
+  return blinkerLit;
+}
+
+void VolvoDIM::genBlinking(unsigned long now)
+{
+  // A new mode restarts the cycle lit, which also keeps both hazard sides in phase.
+  uint8_t mode = blinkerMode;
+  unsigned long start = blinkerStart;
+  if (mode != blinkerShownMode) {
+    blinkerShownMode = mode;
+    start = now;
+    blinkerStart = start;
+  }
+  unsigned long period = blinkerPeriod;
+  uint8_t value = mode;
+  if (period > 0 && mode != blinkerOff) {
+    unsigned long phase = (now - start) % period;
+    if (phase * 100 >= period * blinkerDuty)
+      value = blinkerOff;
+  }
+  txData[arrBlinker][7] = value;
+  blinkerLit = value != blinkerOff;
+}
+
+#if VOLVODIM_ENABLE_WARNINGS
 void VolvoDIM::enableParkingBrake(int enabled) {
   if (enabled == 1)
-    digitalWrite(_parkingBrakePin, HIGH);
+    digitalWrite(parkingBrakePin, HIGH);
   else
-    digitalWrite(_parkingBrakePin, LOW);
+    digitalWrite(parkingBrakePin, LOW);
 }
 
 void VolvoDIM::clearServiceMessage(int enabled) {
@@ -614,15 +896,7 @@ void VolvoDIM::clearServiceMessage(int enabled) {
   else
     defaultData[arrDisplay][7] = 0x3F;
 }
-
-void VolvoDIM::sweepGauges()
-{
-  setRpm(7900);
-  setSpeed(160);
-  delay(500);
-  setRpm(0);
-  setSpeed(0);
-}
+#endif
 
 void VolvoDIM::enableSerialErrorMessages()
 {
@@ -636,35 +910,441 @@ void VolvoDIM::disableSerialErrorMessages()
 
 // -------------------- Simulation Functions --------------------
 
-void VolvoDIM::simulateHighPriority() {
-  genMileageAndSpeed();
-  sendMsgWrapper(addrLi[arrRpm], defaultData[arrRpm]);
+uint16_t VolvoDIM::slotSignature(int slot, const unsigned char* frame)
+{
+  // Position-weighted checksum of the signal bytes; any single byte change
+  // alters it, and a rare collision only delays the frame to its keep-alive.
+  uint8_t mask = pgm_read_byte(&signalMask[slot]);
+  uint8_t sum = 0, weighted = 0;
+  for (int i = 0; i < 8; i++) {
+    if (mask & (1 << i)) {
+      sum += frame[i];
+      weighted += sum;
+    }
+  }
+  return ((uint16_t)weighted << 8) | sum;
+}
+
+unsigned long VolvoDIM::slotPeriod(int slot, bool changed)
+{
+  unsigned long fast = pgm_read_byte(&fastPeriod[slot]);
+  unsigned long slow = pgm_read_byte(&keepAlivePeriod[slot]);
+  unsigned long period = changed ? fast : slow - ((slow - fast) * activity[slot]) / 255;
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+  if (busUtilisation > busLoadBudget) {
+    period = (period * busUtilisation) / busLoadBudget;
+    if (period > slow)
+      period = slow;
+  }
+#endif
+  return period;
+}
+
+unsigned char VolvoDIM::sendSlot(int slot)
+{
+  switch (slot) {
+#if VOLVODIM_ENABLE_ODOMETER
+    case arrSpeed:
+      return genMileageAndSpeed();
+#endif
+#if VOLVODIM_ENABLE_GATEWAY
+    case arrAirbag:
+      return genSRS(slotAddress(slot), txData[slot]);
+    case arrConfig:
+      return genCC(slotAddress(slot), txData[slot]);
+    case arrCoolant:
+      return genTemp(slotAddress(slot), txData[slot]);
+#endif
+    default:
+      break;
+  }
+  if (slot < workingLen)
+    return sendMsgWrapper(slotAddress(slot), txData[slot]);
+  unsigned char frame[8];
+  memcpy_P(frame, defaultFrames[slot], sizeof(frame));
+  return sendMsgWrapper(slotAddress(slot), frame);
+}
+
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+void VolvoDIM::updateBusLoad(unsigned long now)
+{
+  unsigned long elapsed = now - busLoadWindowStart;
+  if (elapsed >= busLoadWindow) {
+    // Taken in one step so frames the producer thread sends meanwhile count
+    // towards the next window.
+#if VOLVODIM_ENABLE_THREADED
+    unsigned long bits = busBitsSent.exchange(0);
+#else
+    unsigned long bits = busBitsSent;
+    busBitsSent = 0;
+#endif
+    busUtilisation = (bits * 100) / ((busBitRate / 1000) * elapsed);
+    busLoadWindowStart = now;
+  }
+}
+
+void VolvoDIM::setBusLoadBudget(int percent)
+{
+  if (percent < 1)
+    percent = 1;
+  else if (percent > 100)
+    percent = 100;
+  busLoadBudget = percent;
+}
+
+int VolvoDIM::getBusUtilisation()
+{
+  return busUtilisation;
+}
+
+#endif
+
+// ------------------------- Memory -------------------------
+//
+// Static RAM (.data plus .bss) of the whole program, taken from the linker's
+// section symbols so only what survived the link is counted. Returns 0 on
+// toolchains that do not export them.
+#if defined(__AVR__)
+extern char __data_start, __data_end, __bss_start, __bss_end;
+#elif defined(ESP32)
+extern char _data_start, _data_end, _bss_start, _bss_end;
+#elif defined(__linux__)
+extern char __data_start, _edata, __bss_start, _end;
+#endif
+
+unsigned int VolvoDIM::getRamUsage()
+{
+#if defined(__AVR__)
+  return (&__data_end - &__data_start) + (&__bss_end - &__bss_start);
+#elif defined(ESP32)
+  return (&_data_end - &_data_start) + (&_bss_end - &_bss_start);
+#elif defined(__linux__)
+  return (&_edata - &__data_start) + (&_end - &__bss_start);
+#else
+  return 0;
+#endif
+}
+
+// -------------------- Bus Health Functions --------------------
+
+unsigned char VolvoDIM::readControllerRegister(unsigned char reg)
+{
+#if VOLVODIM_ENABLE_THREADED
+  std::lock_guard<std::mutex> lock(canMutex);
+#endif
+  return CAN.readRegister(reg);
+}
+
+unsigned char VolvoDIM::readErrorFlags()
+{
+#if VOLVODIM_ENABLE_THREADED
+  std::lock_guard<std::mutex> lock(canMutex);
+#endif
+  unsigned char flags = 0;
+  CAN.checkError(&flags);
+  return flags;
+}
+
+void VolvoDIM::restartController()
+{
+#if VOLVODIM_ENABLE_THREADED
+  std::lock_guard<std::mutex> lock(canMutex);
+#endif
+  CAN.begin(CAN_125KBPS, MCP_16MHz);
+}
+
+void VolvoDIM::checkBusHealth(unsigned long now)
+{
+  if (now - lastBusCheck < busCheckPeriod)
+    return;
+  lastBusCheck = now;
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+  txErrorCount = readControllerRegister(regTec);
+  rxErrorCount = readControllerRegister(regRec);
+#endif
+  errorFlags = readErrorFlags();
+  bool faulted = errorFlags & (eflgTxBusOff | eflgTxPassive | eflgRxPassive);
+
+  if (faulted && !busDown) {
+    busDown = true;
+    outageStart = now;
+    lastControllerReset = now;
+    probeAcked = false;
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+    busOutageCount++;
+    if (busLostCallback)
+      busLostCallback();
+#endif
+  } else if (!faulted && busDown && probeAcked) {
+    busDown = false;
+    handshakeStep = 0;
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+    lastOutageDuration = now - outageStart;
+    if (busRecoveredCallback)
+      busRecoveredCallback(lastOutageDuration);
+#endif
+  }
+
+  if (busDown) {
+    // The MCP2515 leaves bus-off on its own once the bus idles; restart it
+    // (a single attempt, unlike init()) only if it stays stuck.
+    if ((errorFlags & eflgTxBusOff) && now - lastControllerReset >= controllerResetTime) {
+      restartController();
+      lastControllerReset = now;
+    }
+    // The driver waits for TXREQ to clear, so CAN_OK means a node acked it.
+    probeAcked = sendSlot(arrSpeed) == CAN_OK;
+  }
+}
+
+void VolvoDIM::stepHandshake(unsigned long now)
+{
+  if (handshakeStep >= handshakeLen || now - lastHandshakeTime < handshakeSpacing)
+    return;
+  sendHandshakeFrame(handshakeStep);
+  handshakeStep++;
+  lastHandshakeTime = now;
+}
+
+bool VolvoDIM::isBusOk()
+{
+  return !busDown;
+}
+
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+void VolvoDIM::setBusCallbacks(void (*onLost)(), void (*onRecovered)(unsigned long outageMs))
+{
+  busLostCallback = onLost;
+  busRecoveredCallback = onRecovered;
 }
 
-void VolvoDIM::simulateLowPriority() {
-  sendMsgWrapper(addrLi[arrBrakes], defaultData[arrBrakes]);
-  sendMsgWrapper(addrLi[arrAntiSkid], defaultData[arrAntiSkid]);
-  genSRS(addrLi[arrAirbag], defaultData[arrAirbag]);
-  sendMsgWrapper(addrLi[arr4c], defaultData[arr4c]);
-  genCC(addrLi[arrConfig], defaultData[arrConfig]);
-  sendMsgWrapper(addrLi[arrTime], defaultData[arrTime]);
-  genTemp(addrLi[arrCoolant], defaultData[arrCoolant]);
-  sendMsgWrapper(addrLi[arrBlinker], defaultData[arrBlinker]);
-  sendMsgWrapper(addrLi[arrGear], defaultData[arrGear]);
-  sendMsgWrapper(addrLi[arrDmWindow], defaultData[arrDmWindow]);
-  sendMsgWrapper(addrLi[arrDmMessage], defaultData[arrDmMessage]);
-  sendMsgWrapper(addrLi[arrDisplay], defaultData[arrDisplay]);
+int VolvoDIM::getTxErrorCount()
+{
+  return txErrorCount;
 }
 
+int VolvoDIM::getRxErrorCount()
+{
+  return rxErrorCount;
+}
+
+unsigned int VolvoDIM::getBusOutageCount()
+{
+  return busOutageCount;
+}
+
+unsigned long VolvoDIM::getLastOutageDuration()
+{
+  return lastOutageDuration;
+}
+#endif
+
+// -------------------- Animation Functions --------------------
+#if VOLVODIM_ENABLE_ANIMATION
+
+void VolvoDIM::playAnimation(uint8_t channel, const Keyframe* frames, uint8_t count, bool loop)
+{
+  if (channel >= ANIM_CHANNELS || frames == NULL || count == 0)
+    return;
+  animations[channel].frames = frames;
+  animations[channel].count = count;
+  animations[channel].loop = loop;
+  animations[channel].start = millis();
+  animations[channel].lastValue = INT16_MIN;
+}
+
+void VolvoDIM::stopAnimation(uint8_t channel)
+{
+  if (channel < ANIM_CHANNELS)
+    animations[channel].frames = NULL;
+}
+
+bool VolvoDIM::isAnimating(uint8_t channel)
+{
+  return channel < ANIM_CHANNELS && animations[channel].frames != NULL;
+}
+
+void VolvoDIM::sweepGauges()
+{
+  playAnimation(ANIM_RPM, sweepRpmFrames, sizeof(sweepRpmFrames) / sizeof(Keyframe));
+  playAnimation(ANIM_SPEED, sweepSpeedFrames, sizeof(sweepSpeedFrames) / sizeof(Keyframe));
+}
+
+// Host writes take over from an animation on the same channel.
+void VolvoDIM::releaseAnimation(uint8_t channel)
+{
+  if (!applyingAnimation)
+    animations[channel].frames = NULL;
+}
+
+void VolvoDIM::applyAnimation(uint8_t channel, int value)
+{
+  applyingAnimation = true;
+  switch (channel) {
+    case ANIM_RPM:        setRpm(value); break;
+    case ANIM_SPEED:      setSpeed(value); break;
+    case ANIM_FUEL:       setGasLevel(value); break;
+    case ANIM_COOLANT:    setCoolantTemp(value); break;
+    case ANIM_BRIGHTNESS: setTotalBrightness(value); break;
+  }
+  applyingAnimation = false;
+}
+
+void VolvoDIM::stepAnimations(unsigned long now)
+{
+  for (uint8_t channel = 0; channel < ANIM_CHANNELS; channel++) {
+    AnimationState& anim = animations[channel];
+    if (anim.frames == NULL)
+      continue;
+
+    Keyframe last;
+    memcpy_P(&last, &anim.frames[anim.count - 1], sizeof(last));
+    unsigned long elapsed = now - anim.start;
+    int value;
+    if (elapsed >= last.time && !(anim.loop && last.time > 0)) {
+      value = last.value;
+      anim.frames = NULL;
+    } else {
+      if (anim.loop && last.time > 0)
+        elapsed %= last.time;
+      Keyframe from, to;
+      memcpy_P(&to, &anim.frames[0], sizeof(to));
+      from = to;
+      for (uint8_t i = 1; i < anim.count && to.time <= elapsed; i++) {
+        from = to;
+        memcpy_P(&to, &anim.frames[i], sizeof(to));
+      }
+      if (elapsed < from.time || to.time <= from.time || elapsed >= to.time) {
+        value = (elapsed >= to.time) ? to.value : from.value;
+      } else {
+        // Progress through the segment in 1/256 steps, then ease it.
+        long t = ((long)(elapsed - from.time) * 256) / (to.time - from.time);
+        if (to.easing == EASE_STEP)
+          t = 0;
+        else if (to.easing == EASE_IN_OUT)
+          t = (t * t * (768 - 2 * t)) / 65536;
+        value = from.value + (((long)to.value - from.value) * t) / 256;
+      }
+    }
+
+    if (value != anim.lastValue) {
+      anim.lastValue = value;
+      applyAnimation(channel, value);
+    }
+  }
+}
+#endif
+
+// -------------------- Scheduler Entry Point --------------------
+
 void VolvoDIM::simulate() {
-  simulateHighPriority();
-  static unsigned long lastLowPriorityTime = 0;
-  if (millis() - lastLowPriorityTime >= 50) {
-    simulateLowPriority();
-    lastLowPriorityTime = millis();
+#if VOLVODIM_ENABLE_THREADED
+  publish();
+  transmit();
+#else
+#if VOLVODIM_ENABLE_ANIMATION
+  stepAnimations(millis());
+#endif
+  runScheduler(millis());
+#endif
+}
+
+#if VOLVODIM_ENABLE_THREADED
+// Producer side: call after the setters to hand the current frames to the
+// transmit thread.
+void VolvoDIM::publish()
+{
+#if VOLVODIM_ENABLE_ANIMATION
+  stepAnimations(millis());
+#endif
+  unsigned long now = micros();
+  for (int slot = 0; slot < workingLen; slot++) {
+    uint16_t signature = slotSignature(slot, defaultData[slot]);
+    if (signature != publishedSignature[slot]) {
+      publishedSignature[slot] = signature;
+      slotChangeStamp[slot] = now;
+    }
+  }
+  memcpy(snapshots[producerSnapshot], defaultData, sizeof(defaultData));
+  memcpy(snapshotSlotStamp[producerSnapshot], slotChangeStamp, sizeof(slotChangeStamp));
+  producerSnapshot = latestSnapshot.exchange(producerSnapshot | snapshotFresh) & 0x03;
+}
+
+// Transmit side: picks up the newest published frames, then runs the
+// scheduler on them.
+void VolvoDIM::transmit()
+{
+  if (latestSnapshot.load() & snapshotFresh) {
+    consumerSnapshot = latestSnapshot.exchange(consumerSnapshot) & 0x03;
+    txData = snapshots[consumerSnapshot];
+    // A slot whose stamp moved carries a change the wire has not seen; a
+    // newer change to a slot still pending restarts its clock.
+    for (int slot = 0; slot < workingLen; slot++) {
+      if (snapshotSlotStamp[consumerSnapshot][slot] != pendingSlotStamp[slot]) {
+        pendingSlotStamp[slot] = snapshotSlotStamp[consumerSnapshot][slot];
+        latencyPending |= 1 << slot;
+      }
+    }
+  }
+  runScheduler(millis());
+}
+
+unsigned long VolvoDIM::getLastPublishLatency()
+{
+  return lastPublishLatency;
+}
+
+unsigned long VolvoDIM::getMaxPublishLatency()
+{
+  return maxPublishLatency;
+}
+#endif
+
+void VolvoDIM::runScheduler(unsigned long now)
+{
+  genBlinking(now);
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+  updateBusLoad(now);
+#endif
+  checkBusHealth(now);
+  if (busDown)
+    return;
+  stepHandshake(now);
+  bool replaying = handshakeStep < handshakeLen;
+  for (int slot = 0; slot < listLen; slot++) {
+    if (replaying && (slot == arrAirbag || slot == arr4c))
+      continue;
+    bool changed = false;
+    uint16_t signature = 0;
+    if (slot < workingLen) {
+      signature = slotSignature(slot, txData[slot]);
+      changed = signature != lastSentSignature[slot];
+    }
+    // Blinker edges go out at once so the lamp cadence is not rounded to the
+    // slot period.
+    bool edge = changed && slot == arrBlinker;
+    if (!edge && (uint16_t)((uint16_t)now - lastSentTime[slot]) < slotPeriod(slot, changed))
+      continue;
+    sendSlot(slot);
+#if VOLVODIM_ENABLE_THREADED
+    // Only a slot the producer changed stops its own clock.
+    if (slot < workingLen && (latencyPending & (1 << slot))) {
+      unsigned long latency = micros() - pendingSlotStamp[slot];
+      lastPublishLatency = latency;
+      if (latency > maxPublishLatency)
+        maxPublishLatency = latency;
+      latencyPending &= ~(1 << slot);
+    }
+#endif
+    activity[slot] = activity[slot] - (activity[slot] / 4) + (changed ? 63 : 0);
+    if (slot < workingLen)
+      lastSentSignature[slot] = signature;
+    lastSentTime[slot] = now;
   }
 }
 
+#if VOLVODIM_ENABLE_GATEWAY
 void VolvoDIM::sendCANMessage(unsigned long canId, byte data[8]) {
   sendMsgWrapper(canId, data);
 }
+#endif
@@ -5,6 +5,7 @@
 #ifndef VolvoDIM_h
 #define VolvoDIM_h
 
+#include "VolvoDIMConfig.h"
 #include "mcp2515_can.h"
 #include <mcp_can.h>
 #include <SPI.h>
@@ -13,6 +14,18 @@
 class VolvoDIM
 {
     public:
+#if VOLVODIM_ENABLE_ANIMATION
+        // Animated channels; values are in the units of the matching setter.
+        enum AnimChannel { ANIM_RPM, ANIM_SPEED, ANIM_FUEL, ANIM_COOLANT, ANIM_BRIGHTNESS, ANIM_CHANNELS };
+        // How a keyframe is approached from the one before it.
+        enum Easing { EASE_STEP, EASE_LINEAR, EASE_IN_OUT };
+        // Keyframe tables must be declared PROGMEM.
+        struct Keyframe {
+            uint16_t time;   // ms from the start of the animation
+            int16_t value;
+            uint8_t easing;
+        };
+#endif
         VolvoDIM(int SPI_CS_PIN, int relayPin=0);
         void setTime(int inputTime);
         int clockToDecimal(int hour, int minute, int AM); 
@@ -31,6 +44,40 @@ class VolvoDIM
         void setRightBlinkerSolid(int state);
         void setGearPosText(const char* gear);
         void setGearPosInt(int gear);
+        void init();
+        void simulate();
+#if VOLVODIM_ENABLE_THREADED
+        void publish();
+        void transmit();
+        unsigned long getLastPublishLatency();
+        unsigned long getMaxPublishLatency();
+#endif
+        void powerOff();
+        void powerOn();
+        void gaugeReset();
+        void enableSerialErrorMessages();
+        void disableSerialErrorMessages();
+        void enableDisableDingNoise(int on);
+        void setBlinker(int right, int left, int hazard);
+        void setBlinkerCadence(int period, int duty=50);
+        unsigned int getBlinkerPhase();
+        bool isBlinkerLit();
+        bool isBusOk();
+        unsigned int getRamUsage();
+#if VOLVODIM_ENABLE_ANIMATION
+        void sweepGauges();
+        void playAnimation(uint8_t channel, const Keyframe* frames, uint8_t count, bool loop=false);
+        void stopAnimation(uint8_t channel);
+        bool isAnimating(uint8_t channel);
+#endif
+#if VOLVODIM_ENABLE_TEXT
+        void setCustomText(const char* text);
+        void displayText(const char* text);
+#endif
+#if VOLVODIM_ENABLE_ODOMETER
+        void enableMilageTracking(int on);
+#endif
+#if VOLVODIM_ENABLE_WARNINGS
         void enableTrailer(int enabled);
         void setError(int error);
         void engineServiceRequiredOrange(int on);
@@ -41,28 +88,59 @@ class VolvoDIM
         void reducedEnginePerformanceRed(int on);
         void slowDownOrShiftUpOrange(int on);
         void reducedEnginePerformanceOrange(int on);
-        void setCustomText(const char* text);
-        void init();
-        void simulate();
-        void powerOff();
-        void powerOn();
-        void gaugeReset();
-        void sweepGauges();
-        void enableSerialErrorMessages();
-        void disableSerialErrorMessages();
-        void enableMilageTracking(int on);
-        void enableDisableDingNoise(int on);
+        void enableHighBeam(int enabled);
+        void enableFog(int enabled);
+        void enableBrake(int enabled);
+        void enableParkingBrake(int enabled);
+        void clearServiceMessage(int enabled);
+#endif
+#if VOLVODIM_ENABLE_GATEWAY
+        void sendCANMessage(unsigned long canId, byte data[8]);
+#endif
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+        void setBusLoadBudget(int percent);
+        int getBusUtilisation();
+        void setBusCallbacks(void (*onLost)(), void (*onRecovered)(unsigned long outageMs));
+        int getTxErrorCount();
+        int getRxErrorCount();
+        unsigned int getBusOutageCount();
+        unsigned long getLastOutageDuration();
+#endif
 
     private:
-        void sendMsgWrapper(unsigned long wId, unsigned char* wBuf);
+        unsigned char sendMsgWrapper(unsigned long wId, unsigned char* wBuf);
+        void sendHandshakeFrame(int step);
         void initSRS();
-        void genSRS(long address, byte stmp[]);
         void init4C();
-        void genCC(long address, byte stmp[]);
-        void genTemp(long address, byte stmp[]);
-        void genBlinking(long address, byte stmp[], bool isBlinking, int interval, int blinkSpeed);
+        void genBlinking(unsigned long now);
+#if VOLVODIM_ENABLE_GATEWAY
+        unsigned char genSRS(long address, byte stmp[]);
+        unsigned char genCC(long address, byte stmp[]);
+        unsigned char genTemp(long address, byte stmp[]);
+#endif
+#if VOLVODIM_ENABLE_TEXT
         void genCustomText(const char* text);
         void clearCustomText();
-        void genMileageAndSpeed();
+#endif
+#if VOLVODIM_ENABLE_ODOMETER
+        unsigned char genMileageAndSpeed();
+#endif
+        uint16_t slotSignature(int slot, const unsigned char* frame);
+        unsigned long slotPeriod(int slot, bool changed);
+        unsigned char sendSlot(int slot);
+#if VOLVODIM_ENABLE_INSTRUMENTATION
+        void updateBusLoad(unsigned long now);
+#endif
+        unsigned char readControllerRegister(unsigned char reg);
+        unsigned char readErrorFlags();
+        void restartController();
+        void checkBusHealth(unsigned long now);
+        void stepHandshake(unsigned long now);
+        void runScheduler(unsigned long now);
+#if VOLVODIM_ENABLE_ANIMATION
+        void stepAnimations(unsigned long now);
+        void applyAnimation(uint8_t channel, int value);
+        void releaseAnimation(uint8_t channel);
+#endif
 };
 #endif
@@ -0,0 +1,59 @@
+/*
+  VolvoDIMConfig.h - Compile-time feature selection for VolvoDIMLib.
+
+  Every subsystem is enabled by default. Define a flag as 0 through your
+  build flags (PlatformIO build_flags, arduino-cli --build-property) or by
+  editing this file to compile that subsystem out entirely:
+
+    VOLVODIM_ENABLE_TEXT             Custom DIM text (setCustomText, displayText)
+    VOLVODIM_ENABLE_ODOMETER         Mileage tracking from the speed signal
+    VOLVODIM_ENABLE_WARNINGS         Lamp setters and the parking brake relay on pin 7
+    VOLVODIM_ENABLE_GATEWAY          SRS/CC/temperature sender emulation and sendCANMessage
+    VOLVODIM_ENABLE_INSTRUMENTATION  Bus utilisation, load budget and bus health counters
+    VOLVODIM_ENABLE_ANIMATION        Keyframe animations and the sweepGauges() startup sweep
+
+  The flags must reach VolvoDIM.cpp as well as your sketch, so a #define in
+  the sketch before the include is not enough. They only add or remove
+  functions and file-scope state; the VolvoDIM class layout is the same in
+  every configuration.
+
+  VOLVODIM_ENABLE_THREADED is off by default. Set it to 1 on dual-core
+  targets (ESP32) or host builds to split simulate() into publish() for the
+  thread running the setters and transmit() for a dedicated CAN thread.
+  It needs <atomic> and <mutex>, so it is not available on AVR.
+
+  extras/size_report.sh builds each configuration on the host and prints
+  its code, constant and RAM use; the last run is in extras/size_report.txt.
+*/
+#ifndef VolvoDIMConfig_h
+#define VolvoDIMConfig_h
+
+#ifndef VOLVODIM_ENABLE_TEXT
+#define VOLVODIM_ENABLE_TEXT 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_ODOMETER
+#define VOLVODIM_ENABLE_ODOMETER 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_WARNINGS
+#define VOLVODIM_ENABLE_WARNINGS 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_GATEWAY
+#define VOLVODIM_ENABLE_GATEWAY 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_INSTRUMENTATION
+#define VOLVODIM_ENABLE_INSTRUMENTATION 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_ANIMATION
+#define VOLVODIM_ENABLE_ANIMATION 1
+#endif
+
+#ifndef VOLVODIM_ENABLE_THREADED
+#define VOLVODIM_ENABLE_THREADED 0
+#endif
+
+#endif